@@ -38,7 +38,17 @@
 #include <push-notification-txn-msg.h>
 
 #include "xaps-daemon.h"
+#include "xaps-probes.h"
 
+/*
+ * Look up the daemon socket for a user. This is read per user rather
+ * than once per process because userdb may override plugin settings
+ * for individual users, and LMTP or IMAP processes serve many users.
+ */
+const char *xaps_get_socket_path(struct mail_user *user) {
+    const char *socket_path = mail_user_plugin_getenv(user, "xaps_socket");
+    return socket_path != NULL ? socket_path : DEFAULT_SOCKPATH;
+}
 
 /*
  * Send the request to our daemon over a unix domain socket. The
@@ -48,39 +58,51 @@
 int send_to_daemon(const char *socket_path, const string_t *payload, struct xaps_attr *xaps_attr) {
     int ret = -1;
 
+    XAPS_PROBE2(send__entry, socket_path, str_len(payload));
+
+    XAPS_PROBE1(connect__entry, socket_path);
     int fd = net_connect_unix(socket_path);
+    XAPS_PROBE2(connect__return, fd, fd < 0 ? errno : 0);
     if (fd == -1) {
         i_error("net_connect_unix(%s) failed: %m", socket_path);
+        XAPS_PROBE1(send__return, -1);
         return -1;
     }
 
     net_set_nonblock(fd, FALSE);
     alarm(1);                     /* TODO: Should be a constant. What is a good duration? */
+    XAPS_PROBE2(write__entry, fd, str_len(payload));
 #ifdef OSTREAM_UNIX_H
     struct ostream *ostream = o_stream_create_unix(fd, (size_t)-1);
     o_stream_cork(ostream);
     o_stream_nsend(ostream, str_data(payload), str_len(payload));
     o_stream_uncork(ostream);
     {
-        if (o_stream_flush(ostream) < 1) {
+        int written = o_stream_flush(ostream);
+        XAPS_PROBE3(write__return, fd, str_len(payload), written);
+        if (written < 1) {
 #else
     {
-        if (net_transmit(fd, str_data(payload), str_len(payload)) < 0) {
+        int written = net_transmit(fd, str_data(payload), str_len(payload));
+        XAPS_PROBE3(write__return, fd, str_len(payload), written);
+        if (written < 0) {
 #endif
             i_error("write(%s) failed: %m", socket_path);
             ret = -1;
         } else {
             char res[1024];
-            ret = net_receive(fd, res, sizeof(res) - 1);
-            if (ret < 0) {
+            XAPS_PROBE1(read__entry, fd);
+            ssize_t len = net_receive(fd, res, sizeof(res) - 1);
+            XAPS_PROBE2(read__return, fd, len);
+            if (len < 0) {
                 i_error("read(%s) failed: %m", socket_path);
             } else {
-                res[ret] = '\0';
+                /* Anything but a complete OK reply, including no reply at all, is a failure */
+                res[len] = '\0';
                 if (strncmp(res, "OK ", 3) == 0) {
                     if (xaps_attr) {
-                        char *tmp;
-                        /* Remove whitespace the end. We expect \r\n. TODO: Looks shady. Is there a dovecot library function for this? */
-                        str_append(xaps_attr->aps_topic, strtok_r(&res[3], "\r\n", &tmp));
+                        /* The topic runs up to the \r\n line ending */
+                        str_append_data(xaps_attr->aps_topic, &res[3], strcspn(&res[3], "\r\n"));
                     }
                     ret = 0;
                 }
@@ -93,6 +115,7 @@ int send_to_daemon(const char *socket_path, const string_t *payload, struct xaps
     alarm(0);
 
     net_disconnect(fd);
+    XAPS_PROBE1(send__return, ret);
     return ret;
 }
 
@@ -116,6 +139,10 @@ static void xaps_str_append_quoted(string_t *dest, const char *str) {
 
 int xaps_notify(const char *socket_path, const char *username, struct mail_user *mailuser , struct mailbox *mailbox, struct push_notification_txn_msg *msg) {
     struct push_notification_txn_event *const *event;
+    int ret;
+
+    XAPS_PROBE2(notify__entry, username, mailbox->name);
+
     /*
      * Construct the request.
      */
@@ -144,7 +171,9 @@ int xaps_notify(const char *socket_path, const char *username, struct mail_user
 
 
     push_notification_driver_debug(XAPS_LOG_LABEL, mailuser, "about to send: %p", req);
-    return send_to_daemon(socket_path, req, NULL);
+    ret = send_to_daemon(socket_path, req, NULL);
+    XAPS_PROBE1(notify__return, ret);
+    return ret;
 }
 
 /**
@@ -152,6 +181,10 @@ int xaps_notify(const char *socket_path, const char *username, struct mail_user
  * hard work.
  */
 int xaps_register(const char *socket_path, struct xaps_attr *xaps_attr) {
+    int ret;
+
+    XAPS_PROBE2(register__entry, xaps_attr->dovecot_username, xaps_attr->aps_account_id);
+
     /*
      * Construct our request.
      */
@@ -176,6 +209,7 @@ int xaps_register(const char *socket_path, struct xaps_attr *xaps_attr) {
         for (; !IMAP_ARG_IS_EOL(xaps_attr->mailboxes); xaps_attr->mailboxes++) {
             const char *mailbox;
             if (!imap_arg_get_astring(&(xaps_attr->mailboxes[0]), &mailbox)) {
+                XAPS_PROBE1(register__return, -1);
                 return -1;
             }
             if (next) {
@@ -188,5 +222,7 @@ int xaps_register(const char *socket_path, struct xaps_attr *xaps_attr) {
     }
     str_append(req, "\r\n");
 
-    return send_to_daemon(socket_path, req, xaps_attr);
+    ret = send_to_daemon(socket_path, req, xaps_attr);
+    XAPS_PROBE1(register__return, ret);
+    return ret;
 }
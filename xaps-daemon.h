@@ -40,6 +40,8 @@ struct xaps_attr {
     string_t *aps_topic;
 };
 
+const char *xaps_get_socket_path(struct mail_user *user);
+
 int send_to_daemon(const char *socket_path, const string_t *payload, struct xaps_attr *xaps_attr);
 
 int xaps_notify(const char *socket_path, const char *username, struct mail_user *mailuser, struct mailbox *mailbox, struct push_notification_txn_msg *msg);
@@ -150,7 +150,7 @@ static bool register_client(struct client_command_context *cmd, struct xaps_attr
     */
     xaps_attr->aps_topic = t_str_new(0);
 
-    if (xaps_register(socket_path, xaps_attr) != 0) {
+    if (xaps_register(xaps_get_socket_path(cmd->client->user), xaps_attr) != 0) {
         client_send_command_error(cmd, "Registration failed.");
         return FALSE;
     }
@@ -193,10 +193,6 @@ static void xaps_client_created(struct client **client) {
     if (mail_user_is_plugin_loaded((*client)->user, xaps_imap_module)) {
         str_append((*client)->capability_string, " XAPPLEPUSHSERVICE");
     }
-    socket_path = mail_user_plugin_getenv((*client)->user, "xaps_socket");
-    if (socket_path == NULL) {
-        socket_path = DEFAULT_SOCKPATH;
-    }
 
     if (next_hook_client_created != NULL) {
         next_hook_client_created(client);
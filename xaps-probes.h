@@ -0,0 +1,49 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2014 Stefan Arentz <stefan@arentz.ca>
+ * Copyright (c) 2017 Frederik Schwan <frederik dot schwan at linux dot com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#ifndef DOVECOT_XAPS_PLUGIN_PROBES_H
+#define DOVECOT_XAPS_PLUGIN_PROBES_H
+
+/*
+ * Static tracepoints for the notify and register paths. When built
+ * with -DXAPS_PROBES=ON these become USDT probes under the "xaps"
+ * provider that perf or bpftrace can attach to, for example:
+ *
+ *   bpftrace -e 'usdt:/usr/lib/dovecot/modules/lib25_xaps_imap_plugin.so:xaps:* { ... }'
+ *
+ * Otherwise they compile away to nothing.
+ */
+#ifdef XAPS_PROBES
+#include <sys/sdt.h>
+#define XAPS_PROBE1(name, a1) DTRACE_PROBE1(xaps, name, a1)
+#define XAPS_PROBE2(name, a1, a2) DTRACE_PROBE2(xaps, name, a1, a2)
+#define XAPS_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(xaps, name, a1, a2, a3)
+#else
+#define XAPS_PROBE1(name, a1) do { } while (0)
+#define XAPS_PROBE2(name, a1, a2) do { } while (0)
+#define XAPS_PROBE3(name, a1, a2, a3) do { } while (0)
+#endif
+
+#endif
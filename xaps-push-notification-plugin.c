@@ -37,9 +37,15 @@
 
 #include "xaps-push-notification-plugin.h"
 #include "xaps-daemon.h"
+#include "xaps-probes.h"
 
 const char *xaps_plugin_version = DOVECOT_ABI_VERSION;
 
+struct xaps_push_notification_user {
+    const char *socket_path;
+    const char *user_lookup;
+};
+
 /*
  * Prepare message handling.
  * On return of false, the event gets dismissed for this driver
@@ -49,6 +55,8 @@ static bool xaps_plugin_begin_txn(struct push_notification_driver_txn *dtxn) {
     struct push_notification_event_messagenew_config *eventMessagenewConfig;
     struct push_notification_event_messageappend_config *eventMessageappendConfig;
 
+    XAPS_PROBE2(begin_txn__entry, dtxn->ptxn->muser->username, dtxn->ptxn->mbox->name);
+
     push_notification_driver_debug(XAPS_LOG_LABEL, dtxn->ptxn->muser, "begin_txn: user: %s mailbox: %s",
                                    dtxn->ptxn->muser->username, dtxn->ptxn->mbox->name);
 
@@ -78,6 +86,7 @@ static bool xaps_plugin_begin_txn(struct push_notification_driver_txn *dtxn) {
             push_notification_event_init(dtxn, (*event)->name, NULL);
         }
     }
+    XAPS_PROBE1(begin_txn__return, TRUE);
     return TRUE;
 }
 
@@ -85,8 +94,11 @@ static bool xaps_plugin_begin_txn(struct push_notification_driver_txn *dtxn) {
  * Process the actual message
  */
 static void xaps_plugin_process_msg(struct push_notification_driver_txn *dtxn, struct push_notification_txn_msg *msg) {
+    struct xaps_push_notification_user *xuser = dtxn->duser->context;
     struct push_notification_txn_event *const *event;
 
+    XAPS_PROBE2(process_msg__entry, dtxn->ptxn->muser->username, dtxn->ptxn->mbox->name);
+
     if (array_is_created(&msg->eventdata)) {
         array_foreach(&msg->eventdata, event) {
             push_notification_driver_debug(XAPS_LOG_LABEL, dtxn->ptxn->muser,
@@ -94,12 +106,14 @@ static void xaps_plugin_process_msg(struct push_notification_driver_txn *dtxn, s
         }
     }
     const char *username = dtxn->ptxn->muser->username;
-    if (user_lookup != NULL) {
-        username = mail_user_plugin_getenv(dtxn->ptxn->muser, user_lookup);
+    if (xuser->user_lookup != NULL) {
+        username = mail_user_plugin_getenv(dtxn->ptxn->muser, xuser->user_lookup);
     }
-    if (xaps_notify(socket_path, username, dtxn->ptxn->muser, dtxn->ptxn->mbox, msg) != 0) {
+    int ret = xaps_notify(xuser->socket_path, username, dtxn->ptxn->muser, dtxn->ptxn->mbox, msg);
+    if (ret != 0) {
         i_error("cannot notify");
     }
+    XAPS_PROBE1(process_msg__return, ret);
 }
 
 // push-notification driver definition
@@ -110,14 +124,14 @@ extern struct push_notification_driver push_notification_driver_xaps;
 
 int xaps_plugin_init(struct push_notification_driver_config *dconfig ATTR_UNUSED,
                  struct mail_user *muser,
-                 pool_t pPool ATTR_UNUSED,
-                 void **pVoid ATTR_UNUSED,
+                 pool_t pPool,
+                 void **pVoid,
                  const char **pString ATTR_UNUSED) {
-    socket_path = mail_user_plugin_getenv(muser, "xaps_socket");
-    if (socket_path == NULL) {
-        socket_path = DEFAULT_SOCKPATH;
-    }
-    user_lookup = mail_user_plugin_getenv(muser, "xaps_user_lookup");
+    struct xaps_push_notification_user *xuser = p_new(pPool, struct xaps_push_notification_user, 1);
+
+    xuser->socket_path = xaps_get_socket_path(muser);
+    xuser->user_lookup = mail_user_plugin_getenv(muser, "xaps_user_lookup");
+    *pVoid = xuser;
     return 0;
 }
 